@@ -0,0 +1,210 @@
+/**
+ * @file   PCNErrorDedup.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cern.ch>
+ * @date   Mon Oct 19 10:14:02 2026
+ *
+ * @brief  Implementation file for PCNErrorDedup
+ *
+ *
+ */
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+
+#include "PCNErrorDedup.hxx"
+
+
+/**
+ * Read the key columns from a parsed row.
+ *
+ * Columns: runNo eventID tell1 ExpPCN Beetle expbits badbits. The
+ * key is packed as: tell1 (8 bits) | Beetle (4) | PCN (8) | XOR (8).
+ *
+ * @return false if the row does not have all columns
+ */
+static bool parseRow(const char *pos, long long &runNo, long long &eventID,
+		     unsigned int &rest)
+{
+  char *end(NULL);
+  unsigned long col[5];
+  int base[5] = {10, 10, 10, 2, 2};
+
+  runNo = strtoll(pos, &end, 10);
+  if (end == pos) return false;
+  pos = end;
+  eventID = strtoll(pos, &end, 10);
+  if (end == pos) return false;
+  pos = end;
+  for (unsigned int i = 0; i < 5; ++i) {
+    col[i] = strtoul(pos, &end, base[i]);
+    if (end == pos) return false;
+    pos = end;
+  }
+
+  rest = (col[0] & 0xff) | (col[2] & 0xf) << 8 |
+    (col[1] & 0xff) << 12 | (col[4] & 0xff) << 20;
+  return true;
+}
+
+
+PCNErrorDedup::PCNErrorDedup(unsigned long maxrows) :
+  _maxrows(maxrows < kMAXROWS ? maxrows : kMAXROWS), _size(0), _rows(0), _dropped(0), _debug(false)
+{
+  // start small, Insert() grows the table up to the maxrows bound
+  Slot empty = {0, 0};
+  _table.assign(1<<10, empty);
+}
+
+
+PCNErrorDedup::~PCNErrorDedup() { _table.clear(); }
+
+
+void PCNErrorDedup::setDebug(bool debug) { _debug = debug; }
+
+
+long PCNErrorDedup::getRows() const { return _rows; }
+
+
+long PCNErrorDedup::getDropped() const { return _dropped; }
+
+
+void PCNErrorDedup::Reset()
+{
+  // only clear the slots in use, runs are often much smaller than the table
+  for (unsigned long i = 0; i < _used.size(); ++i) {
+    _table[_used[i]].eventID = 0;
+    _table[_used[i]].rest    = 0;
+  }
+  _used.clear();
+  _size = 0;
+  return;
+}
+
+
+void PCNErrorDedup::Grow()
+{
+  std::vector<Slot> old;
+  old.reserve(_used.size());
+  for (unsigned long i = 0; i < _used.size(); ++i) old.push_back(_table[_used[i]]);
+
+  Slot empty = {0, 0};
+  _table.assign(2*_table.size(), empty);
+  _used.clear();
+  _size = 0;
+  for (unsigned long i = 0; i < old.size(); ++i)
+    Insert(old[i].eventID, old[i].rest);
+  return;
+}
+
+
+unsigned long PCNErrorDedup::Hash(long long eventID, unsigned int rest) const
+{
+  // 64 bit mix (splitmix64 finaliser)
+  unsigned long long h(eventID ^ ((unsigned long long) rest << 32));
+  h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return h & (_table.size() - 1);
+}
+
+
+bool PCNErrorDedup::Insert(long long eventID, unsigned int rest)
+{
+  rest |= 1u<<31;		// mark slot as used
+
+  unsigned long mask(_table.size() - 1), i(Hash(eventID, rest));
+  while (_table[i].rest) {
+    if (_table[i].rest == rest and _table[i].eventID == eventID) return false;
+    i = (i + 1) & mask;
+  }
+  _table[i].eventID = eventID;
+  _table[i].rest    = rest;
+  _used.push_back(i);
+  ++_size;
+
+  // keep the load factor below 0.5, stop growing past the maxrows bound
+  if (2*_size > _table.size() and _size <= _maxrows) Grow();
+  return true;
+}
+
+
+bool PCNErrorDedup::Filter(std::string infile, std::string outfile)
+{
+  _rows = 0;
+  _dropped = 0;
+  Reset();
+
+  std::ifstream inFile(infile.c_str());
+  std::ofstream outFile(outfile.c_str());
+  if (not inFile or not outFile) {
+    std::cout << "Error   PCNErrorDedup::Filter(): Could not open "
+	      << infile << " or " << outfile << std::endl;
+    return false;
+  }
+
+  long long lastRun(-1), runNo(0), eventID(0);
+  unsigned int rest(0);
+  std::string line;
+  while (std::getline(inFile, line)) {
+    if (parseRow(line.c_str(), runNo, eventID, rest)) {
+      ++_rows;
+      if (runNo != lastRun) {
+	if (_debug and lastRun >= 0)
+	  std::cout << "Debug   PCNErrorDedup::Filter(): run " << lastRun
+		    << ", " << _size << " unique rows" << std::endl;
+	Reset();
+	lastRun = runNo;
+      }
+
+      if (not Insert(eventID, rest)) {
+	++_dropped;
+	continue;
+      }
+      if (_size > _maxrows) {
+	std::cout << "Warning PCNErrorDedup::Filter(): More than " << _maxrows
+		  << " rows in run " << runNo << ", hash set is full." << std::endl;
+	return false;
+      }
+    }
+    outFile << line << '\n';	// unparsable rows are passed through
+  }
+  return true;
+}
+
+
+bool PCNErrorDedup::Sort(std::string infile, std::string outfile)
+{
+  _rows = 0;
+  _dropped = 0;
+
+  // key columns: runNo eventID tell1 ExpPCN Beetle badbits, numeric
+  // keys keep the output in run and event order
+  std::string cmdstring("LC_ALL=C sort -b -u -k1,1n -k2,2n -k3,3n -k4,4n -k5,5n -k7,7 "
+			+ infile + " > " + outfile);
+  if (system(cmdstring.c_str())) {
+    std::cout << "Error   PCNErrorDedup::Sort(): sort command failed!" << std::endl;
+    return false;
+  }
+
+  long nout(0);
+  std::string line;
+  std::ifstream inFile(infile.c_str());
+  while (std::getline(inFile, line)) ++_rows;
+  std::ifstream outFile(outfile.c_str());
+  while (std::getline(outFile, line)) ++nout;
+  _dropped = _rows - nout;
+  return true;
+}
+
+
+bool PCNErrorDedup::Run(_MODE mode, std::string infile, std::string outfile)
+{
+  if (mode == kHASH) {
+    if (Filter(infile, outfile)) return true;
+    std::cout << "Warning PCNErrorDedup::Run(): Falling back to external sort."
+	      << std::endl;
+  }
+  if (mode == kHASH or mode == kSORT) return Sort(infile, outfile);
+  return false;
+}
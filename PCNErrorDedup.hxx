@@ -0,0 +1,151 @@
+/**
+ * @file   PCNErrorDedup.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cern.ch>
+ * @date   Mon Oct 19 10:12:40 2026
+ *
+ * @brief  Definition for the PCNErrorDedup class.
+ *
+ *         Vetra sometimes prints the same PCN error table row more
+ *         than once (repeated dumps, re-processed events). The
+ *         PCNErrorDedup class drops these duplicate rows from the
+ *         space separated file produced by the parser before it is
+ *         read into a TTree.
+ *
+ *         A row is identified by (runNo, eventID, tell1, Beetle, PCN,
+ *         XOR), read from the columns of the default parser header:
+ *         runNo eventID tell1 ExpPCN Beetle expbits badbits
+ *
+ */
+
+#ifndef __PCNERRORDEDUP_HXX
+#define __PCNERRORDEDUP_HXX
+
+
+#include <string>
+#include <vector>
+
+
+/// PCNErrorDedup drops duplicate rows from parsed PCN error tables
+class PCNErrorDedup {
+public:
+
+  /// Define deduplication modes.
+  enum _MODE {
+    kNONE,			/**< Keep all rows */
+    kHASH,			/**< Streaming hash set, scoped per run */
+    kSORT			/**< Exact external sort (sort -u) */
+  };
+
+  /// Upper bound for maxrows (~7 GB of memory).
+  enum { kMAXROWS = 100000000 };
+
+  /**
+   * Constructor initialised with the maximum number of rows to keep
+   * in memory for a single run.
+   *
+   * The hash table starts small and doubles as rows are added, up
+   * to the smallest power of 2 above 2*maxrows slots. With the used
+   * slot list this is at most ~72 bytes per row.
+   *
+   * @param maxrows Maximum number of distinct rows per run (at most kMAXROWS)
+   */
+  PCNErrorDedup(unsigned long maxrows);
+  ~PCNErrorDedup();
+
+  /**
+   * Set debug mode. This changes message verbosity.
+   *
+   * @param debug Debug mode boolean
+   */
+  void setDebug(bool debug);
+
+  /**
+   * Stream through the input file and write unique rows to output.
+   *
+   * Rows are compared with all rows seen so far for the same run;
+   * the hash set is cleared whenever runNo changes. Row order is
+   * preserved. If a run has more distinct rows than the hash set
+   * can hold, the pass is abandoned and false is returned, so that
+   * the caller can fall back to Sort().
+   *
+   * @param infile Space separated input file
+   * @param outfile Output file with unique rows
+   *
+   * @return false if the hash set overflowed or a file could not be opened
+   */
+  bool Filter(std::string infile, std::string outfile);
+
+  /**
+   * Write unique rows to output using an external sort.
+   *
+   * Exact for inputs of any size. Rows are written in increasing
+   * run number and event id (then TELL1 id, PCN and Beetle), so the
+   * original order within an event is not preserved. Unlike Filter(),
+   * duplicates are also found when the rows of a run are not
+   * contiguous in the input.
+   *
+   * @param infile Space separated input file
+   * @param outfile Output file with unique rows
+   *
+   * @return false if the sort command failed
+   */
+  bool Sort(std::string infile, std::string outfile);
+
+  /**
+   * Run Filter() or Sort() depending on mode.
+   *
+   * In kHASH mode Sort() is used as fallback when Filter() fails.
+   *
+   * @param mode Deduplication mode
+   * @param infile Space separated input file
+   * @param outfile Output file with unique rows
+   *
+   * @return false on failure
+   */
+  bool Run(_MODE mode, std::string infile, std::string outfile);
+
+  long getRows() const;		/**< Number of rows read in the last pass. */
+  long getDropped() const;	/**< Number of duplicate rows dropped in the last pass. */
+
+private:
+
+  /**
+   * Insert a row key in the hash set.
+   *
+   * @param eventID Event id
+   * @param rest Packed TELL1 id, Beetle, PCN and XOR
+   *
+   * @return true if the key was not present before
+   */
+  bool Insert(long long eventID, unsigned int rest);
+
+  void Reset();			/**< Clear the hash set. */
+  void Grow();			/**< Double the hash set size and rehash. */
+
+  /**
+   * Return the hash set slot for a row key.
+   *
+   * @param eventID Event id
+   * @param rest Packed key
+   *
+   * @return Slot index
+   */
+  unsigned long Hash(long long eventID, unsigned int rest) const;
+
+  /// Hash set slot.
+  struct Slot {
+    long long    eventID;	/**< Event id */
+    unsigned int rest;		/**< Packed key, MSB set when the slot is used */
+  };
+
+  std::vector<Slot> _table;	/**< Open addressing hash set. */
+  std::vector<unsigned long> _used; /**< Slots in use since the last Reset(). */
+  unsigned long _maxrows;	/**< Maximum number of rows in the hash set. */
+  unsigned long _size;		/**< Current number of rows in the hash set. */
+  long    _rows;		/**< Rows read. */
+  long    _dropped;		/**< Rows dropped. */
+  bool    _debug;		/**< Debug option (changes verbosity). */
+};
+
+
+#endif	// __PCNERRORDEDUP_HXX
@@ -10,6 +10,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 // for debugging
 #include <cassert>
@@ -66,30 +67,6 @@ void PCNError::setBits(std::string pcnbits, std::string xorbits)
 }
 
 
-/////////////////////////
-// Key implementations //
-/////////////////////////
-
-
-Key::Key(unsigned int tell1id, unsigned int beetle) :
-  _key(tell1id|(beetle<<kTELL1ID)) {}
-
-
-Key::~Key() {}
-
-
-unsigned int Key::get(_BITWORD type) const
-{
-  unsigned int num(-1);
-  if (type == kBEETLE) num = _key&kBEETLE;
-  if (type == kTELL1ID) num = _key>>kTELL1ID;
-  return num; 
-}
-
-
-Key::operator unsigned int () const { return _key; }
-
-
 /////////////////////////////////
 // PCNErrorMap implementations //
 /////////////////////////////////
@@ -97,6 +74,8 @@ Key::operator unsigned int () const { return _key; }
 
 PCNErrorMap::PCNErrorMap(unsigned int tell1s) :
   _debug(false),
+  _errors(Key::kSIZE, 0), _tell1Errors(1<<Key::kTELL1ID, 0),
+  _bitFlips(8*Key::kSIZE, 0), _totalBitFlips(8, 0),
   hBeetleMap("hBeetleMap", "PCN error map", tell1s+2, -1.5, tell1s+0.5, 18, -1.5, 16.5)
 {
   hBeetleMap.SetXTitle("Tell1 id");
@@ -122,10 +101,25 @@ void PCNErrorMap::Fill(unsigned int tell1id, unsigned int beetle, PCNError err)
     xorbits(err.getBits(PCNError::kXOR));
 
   if (xorbits.any()) {
+    if (tell1id >= (1u<<Key::kTELL1ID) or beetle >= (1u<<Key::kBEETLE)) {
+      std::cout << "Warning PCNErrorMap::Fill(): Bad TELL1 id " << tell1id
+		<< " or Beetle " << beetle << ", skipping." << std::endl;
+      return;
+    }
+
     // assuming the map elements are initialised to 0
-    unsigned int key(tell1id|(beetle<<8));
+    Key key(tell1id, beetle);
     ErrCounter[key]++;
 
+    // dense counters for the query interface
+    if (_errors[key]++ == 0) _keys.push_back(key);
+    _tell1Errors[tell1id]++;
+    for (unsigned int i = 0; i < 8; ++i) {
+      if (not xorbits.test(i)) continue;
+      _bitFlips[8*key + i]++;
+      _totalBitFlips[i]++;
+    }
+
     hBeetleMap.Fill(tell1id, beetle);
 
     std::stringstream coords, hnum;
@@ -212,3 +206,75 @@ void PCNErrorMap::Write(std::string fname)
   file.Close();
   return;
 }
+
+
+const PCNErrorMap::longMap& PCNErrorMap::getErrCounter() const { return ErrCounter; }
+
+
+long PCNErrorMap::getErrors(Key key) const { return _errors[key]; }
+
+
+long PCNErrorMap::getTELL1Errors(unsigned int tell1id) const
+{
+  if (tell1id >= _tell1Errors.size()) return 0;
+  return _tell1Errors[tell1id];
+}
+
+
+long PCNErrorMap::getTELL1Errors(unsigned int first, unsigned int last) const
+{
+  long sum(0);
+  for (unsigned int i = first; i <= last and i < _tell1Errors.size(); ++i)
+    sum += _tell1Errors[i];
+  return sum;
+}
+
+
+long PCNErrorMap::getBitFlips(unsigned int bit) const
+{
+  if (bit >= 8) return 0;
+  return _totalBitFlips[bit];
+}
+
+
+long PCNErrorMap::getBitFlips(Key key, unsigned int bit) const
+{
+  if (bit >= 8) return 0;
+  return _bitFlips[8*key + bit];
+}
+
+
+/// Order Beetle error counts by decreasing errors, then by key.
+static bool moreErrors(const PCNErrorMap::KeyCount &a, const PCNErrorMap::KeyCount &b)
+{
+  if (a.second != b.second) return a.second > b.second;
+  return a.first < b.first;
+}
+
+
+PCNErrorMap::KeyCountList PCNErrorMap::getWorstBeetles(unsigned int k) const
+{
+  KeyCountList worst;
+  worst.reserve(_keys.size());
+  for (unsigned int i = 0; i < _keys.size(); ++i)
+    worst.push_back(KeyCount(Key(_keys[i]), _errors[_keys[i]]));
+
+  if (k > worst.size()) k = worst.size();
+  std::partial_sort(worst.begin(), worst.begin() + k, worst.end(), moreErrors);
+  worst.resize(k, KeyCount(Key(0), 0));
+  return worst;
+}
+
+
+PCNErrorMap::KeyCountList PCNErrorMap::getBeetles(unsigned int first, unsigned int last) const
+{
+  KeyCountList beetles;
+  for (unsigned int tell1 = first; tell1 <= last and tell1 < _tell1Errors.size(); ++tell1) {
+    if (_tell1Errors[tell1] == 0) continue;
+    for (unsigned int beetle = 0; beetle < (1u<<Key::kBEETLE); ++beetle) {
+      Key key(tell1, beetle);
+      if (_errors[key]) beetles.push_back(KeyCount(key, _errors[key]));
+    }
+  }
+  return beetles;
+}
@@ -23,6 +23,8 @@
 #include <string>
 #include <bitset>
 #include <map>
+#include <vector>
+#include <utility>
 
 #include <TH2D.h>
 // #include <TCanvas.h>
@@ -102,27 +104,44 @@ public:
     kTELL1ID = 8		/**< TELL1 board number (0-131). */
   };
 
+  /// Number of distinct keys, for dense lookup tables.
+  enum { kSIZE = 1 << (kTELL1ID + kBEETLE) };
+
   /**
    * Constructor initialised with the TELL1 id and Beetle chip number.
    *
    * The two numbers are bitshifted and stored as a single number. The
-   * key is initialised as: \f$ key = TELL1 \oplus (Beetle << 4) \f$.
+   * key is initialised as: \f$ key = TELL1 \oplus (Beetle << 8) \f$,
+   * the same as the keys of PCNErrorMap::ErrCounter. Out of range
+   * values are truncated to 8 and 4 bits.
    *
    * @param tell1id TELL1 board number
    * @param beetle Beetle chip number
    */
-  Key(unsigned int tell1id, unsigned int beetle);
-  ~Key();
+  Key(unsigned int tell1id, unsigned int beetle) :
+    _key((tell1id & ((1u<<kTELL1ID)-1)) | (beetle & ((1u<<kBEETLE)-1)) << kTELL1ID) {}
 
-  /** 
+  /**
+   * Constructor initialised from a packed key.
+   *
+   * @param key Packed key, as returned by the type conversion operator
+   */
+  explicit Key(unsigned int key) : _key(key & (kSIZE-1)) {}
+  ~Key() {}
+
+  /**
    * Return TELL1 id or Beetle number depending on type
    *
    * @param type _BITWORD type to return
    *
    * @return TELL1 id or Beetle number
    */
-  unsigned int get(_BITWORD type) const;
-  operator unsigned int () const; /**< Type conversion operator for unsigned integers. */
+  unsigned int get(_BITWORD type) const
+  {
+    return type == kTELL1ID ? _key & ((1u<<kTELL1ID)-1) : _key >> kTELL1ID;
+  }
+
+  operator unsigned int () const { return _key; } /**< Type conversion operator for unsigned integers. */
 
 private:
 
@@ -136,6 +155,8 @@ public:
 
   typedef std::map<unsigned int, TH2D*> TH2DMap; /**< Typedef for a histogram map. */
   typedef std::map<unsigned int, long>  longMap; /**< Typedef for a long map. */
+  typedef std::pair<Key, long>          KeyCount; /**< Typedef for a Beetle and its error count. */
+  typedef std::vector<KeyCount>         KeyCountList; /**< Typedef for a list of Beetle error counts. */
 
   /**
    * Constructor initialised from total number of TELL1 boards.
@@ -160,6 +181,9 @@ public:
    * bins are filled in reverse, MSB to LSB. This is done to
    * correspond with how we would write a binary bit on paper.
    *
+   * Rows with a TELL1 id above 255 or a Beetle number above 15 cannot
+   * be represented by Key and are skipped with a warning.
+   *
    * @param tell1id TELL1 board id
    * @param beetle Beetle number
    * @param err PCN error
@@ -183,12 +207,92 @@ public:
    */
   void Write(std::string fname);
 
+  /**
+   * Return the sparse PCN error map.
+   *
+   * @return Map of error counts keyed by Key
+   */
+  const longMap& getErrCounter() const;
+
+  /**
+   * Return the number of PCN errors for a Beetle.
+   *
+   * @param key Beetle key
+   *
+   * @return Error count
+   */
+  long getErrors(Key key) const;
+
+  /**
+   * Return the number of PCN errors for all Beetles on a TELL1 board.
+   *
+   * @param tell1id TELL1 board id
+   *
+   * @return Error count
+   */
+  long getTELL1Errors(unsigned int tell1id) const;
+
+  /**
+   * Return the number of PCN errors for a range of TELL1 boards.
+   *
+   * @param first First TELL1 board id
+   * @param last Last TELL1 board id (inclusive)
+   *
+   * @return Error count
+   */
+  long getTELL1Errors(unsigned int first, unsigned int last) const;
+
+  /**
+   * Return how often a PCN bit was flipped, summed over all Beetles.
+   *
+   * @param bit Bit number (0 is the LSB)
+   *
+   * @return Number of flips
+   */
+  long getBitFlips(unsigned int bit) const;
+
+  /**
+   * Return how often a PCN bit was flipped for a Beetle.
+   *
+   * @param key Beetle key
+   * @param bit Bit number (0 is the LSB)
+   *
+   * @return Number of flips
+   */
+  long getBitFlips(Key key, unsigned int bit) const;
+
+  /**
+   * Return the Beetles with the most PCN errors.
+   *
+   * @param k Number of Beetles to return
+   *
+   * @return Beetles and error counts, in decreasing order of errors
+   */
+  KeyCountList getWorstBeetles(unsigned int k) const;
+
+  /**
+   * Return all Beetles with PCN errors on a range of TELL1 boards.
+   *
+   * @param first First TELL1 board id
+   * @param last Last TELL1 board id (inclusive)
+   *
+   * @return Beetles and error counts, ordered by TELL1 id and Beetle
+   */
+  KeyCountList getBeetles(unsigned int first, unsigned int last) const;
+
 private:
 
   // counters
   longMap ErrCounter;		/**< A sparse PCN error map. */
   bool    _debug;		/**< Debug option (changes verbosity). */
 
+  // dense counters
+  std::vector<long> _errors;	/**< Dense PCN error map indexed by Key. */
+  std::vector<long> _tell1Errors; /**< PCN errors per TELL1 board. */
+  std::vector<long> _bitFlips;	/**< Flips per bit, indexed by 8*Key + bit. */
+  std::vector<long> _totalBitFlips; /**< Flips per bit for all Beetles. */
+  std::vector<unsigned int> _keys; /**< Keys of Beetles with PCN errors. */
+
   // PCN error maps
   TH2D    hBeetleMap;		/**< PCN error map histogram for all Beetle chips. */
   TH2DMap hperBeetleBitMap;	/**< Map of faulty bits for all Beetles with PCN error. */
@@ -0,0 +1,226 @@
+/**
+ * @file   PCNErrorRate.cxx
+ * @author Suvayu Ali <Suvayu.Ali@cern.ch>
+ * @date   Mon Oct 19 14:03:27 2026
+ *
+ * @brief  Implementation file for PCNErrorRate
+ *
+ *
+ */
+
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+
+#include <TFile.h>
+
+#include "PCNErrorRate.hxx"
+
+
+PCNErrorRate::PCNErrorRate(_AXIS axis, long long binwidth, unsigned int nbins,
+			   int hbins, double tmin, double tmax) :
+  _axis(axis), _binwidth(binwidth > 0 ? binwidth : 1), _nbins(nbins > 0 ? nbins : 1),
+  _hbins(hbins), _tmin(tmin), _tmax(tmax),
+  _nsigma(5), _mincount(10), _alpha(0.002), _debug(false),
+  _windows(Key::kSIZE, NULL) {}
+
+
+PCNErrorRate::~PCNErrorRate()
+{
+  for (unsigned int i = 0; i < _windows.size(); ++i) {
+    if (_windows[i] == NULL) continue;
+    for (unsigned int j = 0; j < _windows[i]->hists.size(); ++j)
+      delete _windows[i]->hists[j];
+    delete _windows[i];
+  }
+  _windows.clear();
+  _alarms.clear();
+}
+
+
+void PCNErrorRate::setDebug(bool debug) { _debug = debug; }
+
+
+void PCNErrorRate::setThreshold(double nsigma, unsigned long mincount, double alpha)
+{
+  if (not (nsigma >= 0) or not (alpha > 0 and alpha <= 1)) {
+    std::cout << "Error   PCNErrorRate::setThreshold(): Need nsigma >= 0 and"
+	      << " 0 < alpha <= 1, threshold unchanged." << std::endl;
+    return;
+  }
+  _nsigma   = nsigma;
+  _mincount = mincount;
+  _alpha    = alpha;
+  return;
+}
+
+
+const PCNErrorRate::AlarmList& PCNErrorRate::getAlarms() const { return _alarms; }
+
+
+void PCNErrorRate::Update(Window &win, double count)
+{
+  // exponentially weighted mean and variance, plain average while
+  // there are fewer than 1/alpha bins to avoid a bias towards 0
+  double weight(std::max(_alpha, 1.0 / (win.nbaseline + 1)));
+  double delta(count - win.mean);
+  win.mean += weight * delta;
+  win.var   = (1 - weight) * (win.var + weight * delta * delta);
+  ++win.nbaseline;
+  return;
+}
+
+
+void PCNErrorRate::Advance(Window &win, long long bin)
+{
+  if (bin <= win.bin) return;
+
+  // bins leaving the window go into the baseline, slots for bins
+  // before the first observed bin were never filled and are skipped
+  long long gap(bin - win.bin);
+  for (long long b = win.bin + 1; b <= bin and b <= win.bin + _nbins; ++b) {
+    unsigned long &slot = win.ring[b % _nbins];
+    if (b - _nbins >= win.first) Update(win, slot);
+    win.sum -= slot;
+    slot = 0;
+  }
+
+  // long gaps: empty bins, the baseline converges after ~5/alpha bins
+  long long nempty(gap - _nbins), nmax(std::ceil(5 / _alpha));
+  for (long long i = 0; i < nempty and i < nmax; ++i) Update(win, 0);
+
+  win.bin = bin;
+  return;
+}
+
+
+void PCNErrorRate::NewHist(Window &win, long long runNo, Key key)
+{
+  std::stringstream coords, hnum;
+  coords << "(" << key.get(Key::kTELL1ID) << "," << key.get(Key::kBEETLE) << ")";
+  hnum   << key.get(Key::kTELL1ID) << "_" << key.get(Key::kBEETLE);
+  std::string hname("hRate_" + hnum.str()),
+    htitle("PCN errors vs time " + coords.str());
+
+  // event ids restart every run, one histogram per run
+  if (_axis == kEVENT) {
+    std::stringstream run;
+    run << runNo;
+    hname  = "hRate_" + run.str() + "_" + hnum.str();
+    htitle = htitle + " run " + run.str();
+  }
+
+  win.hist = new TH1D(hname.c_str(), htitle.c_str(), _hbins, _tmin, _tmax);
+  win.hist->SetXTitle(_axis == kRUN ? "Run no." : "Event id");
+  win.hist->SetYTitle("PCN errors");
+  win.hists.push_back(win.hist);
+  return;
+}
+
+
+void PCNErrorRate::Fill(long long runNo, long long eventID, unsigned int tell1id,
+			unsigned int beetle, PCNError err)
+{
+  if (err.getBits(PCNError::kXOR).none()) return;
+
+  if (tell1id >= (1u<<Key::kTELL1ID) or beetle >= (1u<<Key::kBEETLE)) {
+    std::cout << "Warning PCNErrorRate::Fill(): Bad TELL1 id " << tell1id
+	      << " or Beetle " << beetle << ", skipping." << std::endl;
+    return;
+  }
+  Key key(tell1id, beetle);
+
+  long long time(_axis == kRUN ? runNo : eventID);
+  long long bin(time / _binwidth);
+
+  Window *win = _windows[key];
+  if (win == NULL) {
+    win = _windows[key] = new Window();
+    win->ring.assign(_nbins, 0);
+    win->sum       = 0;
+    win->bin       = bin;
+    win->first     = bin;
+    win->run       = runNo;
+    win->mean      = 0;
+    win->var       = 0;
+    win->nbaseline = 0;
+    win->alarm     = false;
+    NewHist(*win, runNo, key);
+  }
+
+  // event ids restart every run
+  if (_axis == kEVENT and runNo != win->run) {
+    win->ring.assign(_nbins, 0);
+    win->sum   = 0;
+    win->bin   = bin;
+    win->first = bin;
+    win->run   = runNo;
+    win->alarm = false;
+    NewHist(*win, runNo, key);
+  }
+
+  Advance(*win, bin);
+  ++win->ring[win->bin % _nbins];
+  ++win->sum;
+  win->hist->Fill(time);
+
+  // wait for a full window and ~1/alpha bins of baseline before
+  // raising alarms
+  if (win->nbaseline < std::max<double>(_nbins, std::ceil(1 / _alpha))) return;
+
+  // window variance: per bin fluctuations (at least Poisson) plus the
+  // uncertainty of the baseline itself, ~alpha/(2-alpha) of a bin
+  // variance for an exponential average, 1/n while it is a plain one
+  double binvar(std::max(win->var, win->mean)),
+    basevar(std::max(_alpha / (2 - _alpha), 1.0 / win->nbaseline));
+  double expected(_nbins * win->mean),
+    sigma(std::sqrt(std::max(_nbins * binvar * (1 + _nbins * basevar), 1.0)));
+  // Cornish-Fisher skewness correction, Poisson tails are heavier than
+  // gaussian ones for the few counts in a window
+  double threshold(expected + _nsigma * sigma + std::max(_nsigma * _nsigma - 1, 0.0) / 6);
+  bool burst(win->sum >= _mincount and win->sum > threshold);
+
+  if (burst and not win->alarm) {
+    Alarm alarm = {runNo, win->bin * _binwidth, tell1id, beetle, win->sum, expected};
+    _alarms.push_back(alarm);
+    if (_debug)
+      std::cout << "Debug   PCNErrorRate::Fill(): Alarm for (" << tell1id << ","
+		<< beetle << ") at " << time << ", " << win->sum
+		<< " errors, expected " << expected << std::endl;
+  }
+  // hysteresis, one alarm per burst while it is in the window
+  if (burst) win->alarm = true;
+  else if (win->sum <= expected + sigma) win->alarm = false;
+  return;
+}
+
+
+void PCNErrorRate::Print(std::ostream &out) const
+{
+  out << "| runNo | " << (_axis == kRUN ? "run" : "eventID")
+      << " | tell1 | Beetle | errors | baseline |" << std::endl;
+  out << "|-------+---------+-------+--------+--------+----------|" << std::endl;
+  for (AlarmList::const_iterator itr = _alarms.begin(); itr != _alarms.end(); ++itr) {
+    out << "| " << itr->runNo << " | " << itr->time << " | " << itr->tell1
+	<< " | " << itr->beetle << " | " << itr->count << " | " << itr->baseline
+	<< " |" << std::endl;
+  }
+  return;
+}
+
+
+void PCNErrorRate::Write(std::string fname)
+{
+  if (not (fname.length() - fname.rfind(".root") == 5))
+    fname = fname + ".root";
+  TFile file(fname.c_str(), "recreate");
+  file.cd();
+  for (unsigned int i = 0; i < _windows.size(); ++i) {
+    if (_windows[i] == NULL) continue;
+    for (unsigned int j = 0; j < _windows[i]->hists.size(); ++j)
+      _windows[i]->hists[j]->Write();
+  }
+  file.Close();
+  return;
+}
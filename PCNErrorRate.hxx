@@ -0,0 +1,205 @@
+/**
+ * @file   PCNErrorRate.hxx
+ * @author Suvayu Ali <Suvayu.Ali@cern.ch>
+ * @date   Mon Oct 19 14:02:51 2026
+ *
+ * @brief  Definition for the PCNErrorRate class.
+ *
+ *         The PCNErrorRate class looks for bursts of PCN errors on
+ *         individual Beetle chips. For every Beetle it keeps a rolling
+ *         window over event id (or run number) and compares the
+ *         number of errors in the window with a baseline learnt from
+ *         the bins that have left the window. An alarm is raised when
+ *         the window exceeds the baseline by a given number of
+ *         standard deviations.
+ *
+ */
+
+#ifndef __PCNERRORRATE_HXX
+#define __PCNERRORRATE_HXX
+
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include <TH1D.h>
+
+#include "PCNErrorMap.hxx"
+
+
+/// PCNErrorRate implements a rolling window PCN error rate monitor
+class PCNErrorRate {
+public:
+
+  /// Define the time axis of the rolling window.
+  enum _AXIS {
+    kEVENT,			/**< Bin in event id, window is reset every run */
+    kRUN			/**< Bin in run number */
+  };
+
+  /// Alarm raised for a burst of PCN errors on one Beetle.
+  struct Alarm {
+    long long    runNo;		/**< Run number */
+    long long    time;		/**< Start of the bin raising the alarm */
+    unsigned int tell1;		/**< TELL1 board id */
+    unsigned int beetle;	/**< Beetle number */
+    unsigned long count;	/**< Errors in the window */
+    double       baseline;	/**< Expected errors in the window */
+  };
+
+  typedef std::vector<Alarm> AlarmList; /**< Typedef for a list of alarms. */
+
+  /**
+   * Constructor initialised with the window and histogram binning.
+   *
+   * The window spans nbins bins of binwidth events (or runs). The
+   * per Beetle time series histograms have hbins bins between tmin
+   * and tmax. In kEVENT mode event ids restart every run, so there
+   * is one histogram per run and Beetle, each over the full range.
+   *
+   * @param axis Time axis (event id or run number)
+   * @param binwidth Width of a window bin
+   * @param nbins Number of bins in the window
+   * @param hbins Number of bins in the time series histograms
+   * @param tmin Lower edge of the time series histograms
+   * @param tmax Upper edge of the time series histograms
+   */
+  PCNErrorRate(_AXIS axis, long long binwidth, unsigned int nbins,
+	       int hbins, double tmin, double tmax);
+  ~PCNErrorRate();
+
+  /**
+   * Set debug mode. This changes message verbosity.
+   *
+   * @param debug Debug mode boolean
+   */
+  void setDebug(bool debug);
+
+  /**
+   * Set the alarm threshold.
+   *
+   * An alarm is raised when the window count exceeds baseline +
+   * nsigma * sigma and is at least mincount. The baseline is an
+   * exponentially weighted average of the per bin counts with
+   * weight alpha, i.e. a memory of ~2/alpha bins. sigma includes the
+   * statistical uncertainty of the baseline, so a short memory gives
+   * a less sensitive threshold. Invalid values (nsigma < 0, alpha outside
+   * (0, 1]) are rejected and the threshold is left unchanged.
+   *
+   * @param nsigma Number of standard deviations (default: 5)
+   * @param mincount Minimum errors in the window (default: 10)
+   * @param alpha Baseline averaging weight (default: 0.002)
+   */
+  void setThreshold(double nsigma, unsigned long mincount, double alpha);
+
+  /**
+   * Fill the rolling windows.
+   *
+   * Takes the same rows as PCNErrorMap::Fill(), rows without flipped
+   * bits are ignored. Rows are expected in increasing event id (or
+   * run number); rows older than the current bin are counted in the
+   * current bin. The update costs O(1) per row.
+   *
+   * @param runNo Run number
+   * @param eventID Event id
+   * @param tell1id TELL1 board id
+   * @param beetle Beetle number
+   * @param err PCN error
+   */
+  void Fill(long long runNo, long long eventID, unsigned int tell1id,
+	    unsigned int beetle, PCNError err);
+
+  /**
+   * Return the alarms raised so far.
+   *
+   * @return List of alarms
+   */
+  const AlarmList& getAlarms() const;
+
+  /**
+   * Print the alarms as an org-table.
+   *
+   * @param out Output stream
+   */
+  void Print(std::ostream &out) const;
+
+  /**
+   * Write time series histograms to a ROOT file.
+   *
+   * Histograms are named hRate_<tell1>_<beetle> (kRUN), or
+   * hRate_<run>_<tell1>_<beetle> (kEVENT).
+   *
+   * Recreate the ROOT file from the passed string. Add ".root" to the
+   * string if not present before creating the file.
+   *
+   * @param fname ROOT file name (".root" is appended if missing)
+   */
+  void Write(std::string fname);
+
+private:
+
+  // owns the windows and histograms, not copyable
+  PCNErrorRate(const PCNErrorRate &);
+  PCNErrorRate& operator=(const PCNErrorRate &);
+
+  /// Rolling window for one Beetle.
+  struct Window {
+    std::vector<unsigned long> ring; /**< Errors per bin */
+    unsigned long sum;		/**< Errors in the window */
+    long long     bin;		/**< Current bin */
+    long long     first;	/**< First observed bin since creation or reset */
+    long long     run;		/**< Current run */
+    double        mean;		/**< Baseline mean errors per bin */
+    double        var;		/**< Baseline variance of errors per bin */
+    unsigned long nbaseline;	/**< Bins used for the baseline */
+    bool          alarm;	/**< Alarm state */
+    TH1D         *hist;		/**< Current time series histogram */
+    std::vector<TH1D*> hists;	/**< Time series histograms, one per run in kEVENT mode */
+  };
+
+  /**
+   * Create a new time series histogram for a window.
+   *
+   * Named hRate_<tell1>_<beetle> in kRUN mode, and
+   * hRate_<run>_<tell1>_<beetle> in kEVENT mode.
+   *
+   * @param win Window
+   * @param runNo Run number
+   * @param key Beetle key
+   */
+  void NewHist(Window &win, long long runNo, Key key);
+
+  /**
+   * Move the window forward to the given bin.
+   *
+   * @param win Window
+   * @param bin New bin
+   */
+  void Advance(Window &win, long long bin);
+
+  /**
+   * Add a bin count to the baseline.
+   *
+   * @param win Window
+   * @param count Errors in the bin
+   */
+  void Update(Window &win, double count);
+
+  _AXIS     _axis;		/**< Time axis. */
+  long long _binwidth;		/**< Width of a window bin. */
+  unsigned int _nbins;		/**< Number of bins in the window. */
+  int       _hbins;		/**< Time series histogram bins. */
+  double    _tmin;		/**< Time series histogram lower edge. */
+  double    _tmax;		/**< Time series histogram upper edge. */
+  double    _nsigma;		/**< Alarm threshold in standard deviations. */
+  unsigned long _mincount;	/**< Minimum errors for an alarm. */
+  double    _alpha;		/**< Baseline averaging weight. */
+  bool      _debug;		/**< Debug option (changes verbosity). */
+
+  std::vector<Window*> _windows; /**< Windows indexed by Key. */
+  AlarmList _alarms;		/**< Alarms raised. */
+};
+
+
+#endif	// __PCNERRORRATE_HXX
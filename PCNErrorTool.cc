@@ -6,7 +6,7 @@
  * @brief  Make PCN error maps from dumped tree
  *
  *         compile as:
- *         $ g++ -o makePCNErrorMap -Wall $(root-config --cflags --libs) PCNErrorTool.cc PCNErrorMap.cxx
+ *         $ g++ -o makePCNErrorMap -Wall $(root-config --cflags --libs) PCNErrorTool.cc PCNErrorMap.cxx PCNErrorRate.cxx
  * 
  */
 
@@ -14,6 +14,8 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <cstdlib>
+#include <algorithm>
 
 // for debugging
 #include <cassert>
@@ -29,6 +31,7 @@
 #include <TString.h>
 
 #include "PCNErrorMap.hxx"
+#include "PCNErrorRate.hxx"
 
 
 int main(int argc, char *argv[])
@@ -45,6 +48,14 @@ int main(int argc, char *argv[])
     std::cout << "             If an unsupported file format is given, the default"
 	      << std::endl;
     std::cout << "             is used instead (supported formats: png, pdf, ps, C)."
+	      << std::endl << std::endl;
+    std::cout << "   --rates   ROOT file for PCN error rate vs event id histograms,"
+	      << std::endl;
+    std::cout << "             one per run and Beetle (hRate_<run>_<tell1>_<beetle>)."
+	      << std::endl;
+    std::cout << "             Also prints a table of PCN error bursts (default: off)."
+	      << std::endl << std::endl;
+    std::cout << "   --binwidth Events per bin of the rolling rate window (default: 1000)."
 	      << std::endl;
     return 1;
   }
@@ -55,7 +66,8 @@ int main(int argc, char *argv[])
   }
 
   // program options
-  std::string inFile, plotFile;
+  std::string inFile, plotFile, rateFile;
+  long long binwidth(1000);
 
   assert(argc % 2);
   for (unsigned int i = 0; i < arguments.size(); i+=2) {
@@ -63,6 +75,16 @@ int main(int argc, char *argv[])
     opt.ToLower();
     if ( opt.Contains("--input") )  inFile   = value;
     if ( opt.Contains("--output") ) plotFile = value;
+    if ( opt.Contains("--rates") )  rateFile = value;
+    if ( opt.Contains("--binwidth") ) {
+      char *end(NULL);
+      binwidth = strtoll(value.Data(), &end, 10);
+      if (end == value.Data() or *end != '\0' or binwidth < 1) {
+	std::cout << "Error: --binwidth must be a positive number of events"
+		  << std::endl;
+	return 1;
+      }
+    }
   }
 
   if (not (plotFile.length() - plotFile.rfind(".C") == 2 or
@@ -90,6 +112,15 @@ int main(int argc, char *argv[])
   unsigned long nentries(ftree->GetEntries());
 
   PCNErrorMap *errmap = new PCNErrorMap(128); // excluding the 4 pileup sensors
+
+  PCNErrorRate *errrate = NULL;
+  if (rateFile != "") {
+    double tmin(ftree->GetMinimum("eventID")), tmax(ftree->GetMaximum("eventID") + 1);
+    // one histogram per run and Beetle, keep them small
+    int hbins(std::min((tmax - tmin) / binwidth + 1, 1000.0));
+    errrate = new PCNErrorRate(PCNErrorRate::kEVENT, binwidth, 10, hbins, tmin, tmax);
+  }
+
   for (unsigned int i = 0; i < nentries; ++i) {
     ftree->GetEntry(i);
 
@@ -99,6 +130,7 @@ int main(int argc, char *argv[])
 
       PCNError err(expbits,badbits);
       errmap->Fill(tell1, Beetle, err);
+      if (errrate) errrate->Fill(runNo, eventID, tell1, Beetle, err);
     } catch (std::exception &e) {
       std::cout << e.what() << std::endl;
     }
@@ -115,7 +147,13 @@ int main(int argc, char *argv[])
   canvas->Print(plotFile.c_str());
   // errmap->Write("hists.root");
 
+  if (errrate) {
+    errrate->Print(std::cout);
+    errrate->Write(rateFile);
+  }
+
   // house cleaning
+  delete errrate;
   delete errmap;
   file.Close();
   return 0;
@@ -9,7 +9,7 @@
  *         $ sed -ne '/^ *|[0-9 |]\\+| *$/ {s/|//gp}' logfile > space-separated-tempfile
  *
  * 	   compile as:
- *	   $ g++ -o parsePCNErrors -Wall $(root-config --cflags --libs) parsePCNErrors.cc
+ *	   $ g++ -o parsePCNErrors -Wall $(root-config --cflags --libs) parsePCNErrors.cc PCNErrorDedup.cxx
  *
  */
 
@@ -33,6 +33,8 @@
 // BOOST classes
 #include <boost/foreach.hpp>
 
+#include "PCNErrorDedup.hxx"
+
 
 /**
  * This is a test for templated methods.
@@ -61,7 +63,17 @@ int main(int argc, char *argv[])
     std::cout << "   --temp    Temporary file to use (default: /tmp/PCNErrors.txt)."
 	      << std::endl << std::endl;
     std::cout << "   --output  ROOT file to dump TTree (default: PCNErrors.root)."
+	      << std::endl << std::endl;
+    std::cout << "   --dedup   Drop duplicate rows: none, hash or sort (default: none)."
+	      << std::endl;
+    std::cout << "             hash keeps rows of one run in memory and falls back"
+	      << std::endl;
+    std::cout << "             to sort when --maxrows is exceeded. sort is exact and"
+	      << std::endl;
+    std::cout << "             orders rows by run and event." << std::endl << std::endl;
+    std::cout << "   --maxrows Maximum distinct rows per run for hash (default: 4000000,"
 	      << std::endl;
+    std::cout << "             at most 100000000)." << std::endl;
     return 1;
   }
 
@@ -71,7 +83,8 @@ int main(int argc, char *argv[])
   }
 
   // program options
-  std::string inFile, tmpFile, outFile, header, cmdstring;
+  std::string inFile, tmpFile, outFile, header, cmdstring, dedup;
+  unsigned long maxrows(4000000);
 
   assert(argc % 2);
   for (unsigned int i = 0; i < arguments.size(); i+=2) {
@@ -81,6 +94,16 @@ int main(int argc, char *argv[])
     if ( opt.Contains("--temp") )   tmpFile = value.Data();
     if ( opt.Contains("--output") ) outFile = value.Data();
     if ( opt.Contains("--header") ) header  = value.Data();
+    if ( opt.Contains("--dedup") )  dedup   = value.Data();
+    if ( opt.Contains("--maxrows") ) {
+      char *end(NULL);
+      maxrows = strtoul(value.Data(), &end, 10);
+      if (*end != '\0' or value.BeginsWith("-") or maxrows > PCNErrorDedup::kMAXROWS) {
+	std::cout << "Error: --maxrows must be a number between 0 and "
+		  << PCNErrorDedup::kMAXROWS << std::endl;
+	return 1;
+      }
+    }
   }
 
   if (tmpFile == "") tmpFile = "/tmp/PCNErrors.txt";
@@ -88,6 +111,16 @@ int main(int argc, char *argv[])
   if (header  == "")
     header = "runNo/L:eventID/L:tell1/I:ExpPCN/I:Beetle/I:expbits/C:badbits/C";
 
+  // deduplication mode, checked before any files are written
+  PCNErrorDedup::_MODE mode(PCNErrorDedup::kNONE);
+  if (dedup == "hash") mode = PCNErrorDedup::kHASH;
+  else if (dedup == "sort") mode = PCNErrorDedup::kSORT;
+  else if (dedup != "" and dedup != "none") {
+    std::cout << "Error: unknown --dedup mode " << dedup
+	      << " (use none, hash or sort)." << std::endl;
+    return 1;
+  }
+
   // parse only rows with numbers or white space
   cmdstring = "sed -ne '/^ *|[0-9 |]\\+| *$/ {s/|//gp}' "
     + inFile + " > " + tmpFile;
@@ -97,14 +130,28 @@ int main(int argc, char *argv[])
     return 1;
   }
 
+  // drop duplicate rows, key: (runNo, eventID, tell1, Beetle, PCN, XOR)
+  std::string treeFile(tmpFile);
+  if (mode != PCNErrorDedup::kNONE) {
+    treeFile = tmpFile + ".dedup";
+    PCNErrorDedup filter(mode == PCNErrorDedup::kHASH ? maxrows : 0);
+    if (not filter.Run(mode, tmpFile, treeFile)) {
+      std::cout << "Error: deduplication failed!" << std::endl;
+      return 1;
+    }
+    std::cout << "Info: dropped " << filter.getDropped() << " duplicate rows out of "
+	      << filter.getRows() << std::endl;
+  }
+
   TTree ftree("ftree", "PCN error tree");
-  ftree.ReadFile(tmpFile.c_str(), header.c_str());
+  ftree.ReadFile(treeFile.c_str(), header.c_str());
 
   TFile file(outFile.c_str(), "recreate");
   ftree.Write();
   file.Close();
 
   system(std::string("rm -rf " + tmpFile).c_str());
+  if (treeFile != tmpFile) system(std::string("rm -rf " + treeFile).c_str());
 
   return 0;
 }